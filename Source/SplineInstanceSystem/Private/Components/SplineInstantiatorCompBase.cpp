@@ -1,13 +1,108 @@
 #include "Components/SplineInstantiatorCompBase.h"
 #include "Components/SplineComponent.h"
 #include "Types/SplineInstanceSystemTypes.h"
+#include "Net/UnrealNetwork.h"
+#include "Engine/World.h"
+#include "Algo/BinarySearch.h"
 
 USplineInstantiatorCompBase::USplineInstantiatorCompBase()
 {
 	PrimaryComponentTick.bCanEverTick = false;
+
+	// Only the spline state is replicated: clients regenerate instances on their own.
+	SetIsReplicatedByDefault(true);
 }
 
 void USplineInstantiatorCompBase::Instantiate()
+{
+	if (!CanInstantiate())
+	{
+		return;
+	}
+
+	if (InstantiationSettings.InstantiationMethod == ESplineInstantiationMethod::InstanceCount_AdjustSpline)
+	{
+		// Adjust spline.
+	}
+
+	// Distances are accumulated in double and each section is evaluated on the curve keys of its spline segment with a double parameter,
+	// since the engine distance and input key queries take floats.
+	const double SectionLength = InstantiationSettings.SectionLength;
+	const TArray<double> SegmentStartDistances = GetSegmentStartDistances();
+
+	// In ChunkRelative mode, section positions are given relative to the origin of the chunk they start in.
+	const bool bChunkRelative = InstantiationSettings.SamplingMode == ESplineSamplingMode::ChunkRelative;
+	int32 ChunkIndex = INDEX_NONE;
+	FVector ChunkOrigin = FVector::ZeroVector;
+
+	// Generates a new instance for each needed section count.
+	const int32 SectionsCount = GetSectionsCount();
+	const bool bUsesInstanceHandles = UsesInstanceHandles();
+	if (bUsesInstanceHandles)
+	{
+		InstanceHandleEntries.Reserve(InstanceHandleEntries.Num() + SectionsCount);
+	}
+	else
+	{
+		Instances.Reserve(Instances.Num() + SectionsCount);
+	}
+
+	for (int32 i = 0; i < SectionsCount; i++)
+	{	
+		// The starting position of the current segment coincides with the ending position of the previous segment.
+		const double StartDistance = i * SectionLength;
+		
+		// The ending position of the current segment coincides with the starting position of the next segment.
+		const double EndDistance = (i + 1) * SectionLength;
+		
+		// Starting and Ending positions are calculated in local-space!!
+		FVector StartPosition;
+		FVector StartTangent;
+		GetLocalPositionAndTangentAtDistance(StartDistance, SegmentStartDistances, StartPosition, StartTangent);
+		StartTangent = StartTangent.GetClampedToMaxSize(InstantiationSettings.SectionLength); // Tangents are clamped to SectionLenght
+
+		FVector EndPosition;
+		FVector EndTangent;
+		GetLocalPositionAndTangentAtDistance(EndDistance, SegmentStartDistances, EndPosition, EndTangent);
+		EndTangent = EndTangent.GetClampedToMaxSize(InstantiationSettings.SectionLength); // Tangents are clamped to SectionLenght
+
+		if (bChunkRelative)
+		{
+			// Distances are never negative, so truncation is the same as flooring.
+			const int32 CurrentChunkIndex = static_cast<int32>(StartDistance / InstantiationSettings.ChunkLength);
+			if (CurrentChunkIndex != ChunkIndex)
+			{
+				ChunkIndex = CurrentChunkIndex;
+				const double ChunkStartDistance = ChunkIndex * static_cast<double>(InstantiationSettings.ChunkLength);
+				FVector ChunkTangent;
+				GetLocalPositionAndTangentAtDistance(ChunkStartDistance, SegmentStartDistances, ChunkOrigin, ChunkTangent);
+			}
+		}
+
+		const FSplineSegmentInfo SplineSegment{ StartPosition - ChunkOrigin, StartTangent, EndPosition - ChunkOrigin, EndTangent, ChunkOrigin };
+
+		// Each child class will implement its own version of the method.
+		if (bUsesInstanceHandles)
+		{
+			AddInstanceHandle(GenerateInstancePayload(SplineSegment));
+		}
+		else
+		{
+			UObject* Instance = GenerateInstance(SplineSegment);
+			Instances.Add(Instance);
+		}
+	}
+
+	bInstantiated = true;
+	GeneratedSettingsHash = GetTypeHash(InstantiationSettings);
+
+	if (ShouldReplicateState())
+	{
+		UpdateReplicatedState();
+	}
+}
+
+bool USplineInstantiatorCompBase::CanInstantiate() const
 {
 #pragma region ValidateInstantiationSettings
 	bool bCanInstantiate = true;
@@ -28,6 +123,16 @@ void USplineInstantiatorCompBase::Instantiate()
 		bCanInstantiate = false;
 	}
 
+	if (InstantiationSettings.UpAxis != EOrientationAxis::None && 
+		(InstantiationSettings.UpAxis == InstantiationSettings.ForwardAxis || 
+		InstantiationSettings.UpAxis == FOrientationAxisHelpers::GetOppositeAxis(InstantiationSettings.ForwardAxis)))
+	{
+		UE_LOG(LogSplineInstantiator, Error,
+			TEXT("[%s] InstantiationSettings.UpAxis is parallel to ForwardAxis."),
+			*GetName());
+		bCanInstantiate = false;
+	}
+
 	if (InstantiationSettings.InstantiationMethod == ESplineInstantiationMethod::None)
 	{
 		UE_LOG(LogSplineInstantiator, Error,
@@ -36,54 +141,235 @@ void USplineInstantiatorCompBase::Instantiate()
 		bCanInstantiate = false;
 	}
 
-	if (!bCanInstantiate)
+	if (InstantiationSettings.SamplingMode == ESplineSamplingMode::ChunkRelative && InstantiationSettings.ChunkLength <= 0.0f)
 	{
-		return; 
+		UE_LOG(LogSplineInstantiator, Error,
+			TEXT("[%s] InstantiationSettings.ChunkLength must be greater than zero in ChunkRelative mode."),
+			*GetName());
+		bCanInstantiate = false;
 	}
 #pragma endregion 
 
-	if (InstantiationSettings.InstantiationMethod == ESplineInstantiationMethod::InstanceCount_AdjustSpline)
+	return bCanInstantiate;
+}
+
+void USplineInstantiatorCompBase::ClearInstances()
+{
+	// Handle-based instances are destroyed in bulk by the child class, then all handles are released at once.
+	// Not conditioned on registered handles: a duplicated component inherits its source instances but not their handles.
+	if (InstanceHandleEntries.Num() > 0 || UsesInstanceHandles())
 	{
-		// Adjust spline.
+		DestroyHandleInstances();
+		InstanceHandleEntries.Empty();
 	}
 
-	// Generates a new instance for each needed section count.
-	for (int32 i = 0; i < GetSectionsCount(); i++)
-	{	
-		// The starting position of the current segment coincides with the ending position of the previous segment.
-		const float StartDistance = i * InstantiationSettings.SectionLength;
-		
-		// The ending position of the current segment coincides with the starting position of the next segment.
-		const float EndDistance = (i + 1) * InstantiationSettings.SectionLength;
-		
-		// Starting and Ending positions are calculated in local-space!!
-		const ESplineCoordinateSpace::Type CoordinateSpace = ESplineCoordinateSpace::Type::Local;
+	for (int32 i = 0; i < Instances.Num(); i++)
+	{
+		// Each child class will implement its own version of the method.
+		DestroyInstance(Instances[i]);
+	}
+	Instances.Empty();
+	bInstantiated = false;
+}
 
-		// Calculate the current segment along the spline.
-		const FVector StartPosition = GetLocationAtDistanceAlongSpline(StartDistance, CoordinateSpace);
-		
-		const FVector StartTangent = GetTangentAtDistanceAlongSpline(StartDistance, CoordinateSpace)
-			.GetClampedToMaxSize(InstantiationSettings.SectionLength); // Tangents are clamped to SectionLenght
-		
-		const FVector EndPosition = GetLocationAtDistanceAlongSpline(EndDistance, CoordinateSpace);
-		
-		const FVector EndTangent = GetTangentAtDistanceAlongSpline(EndDistance, CoordinateSpace)
-			.GetClampedToMaxSize(InstantiationSettings.SectionLength); // Tangents are clamped to SectionLenght
+void USplineInstantiatorCompBase::Regenerate()
+{
+	// Validate before clearing, so invalid settings don't wipe the current instances.
+	if (!CanInstantiate())
+	{
+		return;
+	}
 
-		// Each child class will implement its own version of the method.
-		UObject* Instance = GenerateInstance(FSplineSegmentInfo{ StartPosition, StartTangent, EndPosition, EndTangent });
-		Instances.Add(Instance);
+	ClearInstances();
+	Instantiate();
+}
+
+FSplineInstanceHandle USplineInstantiatorCompBase::AddInstanceHandle(int32 Payload)
+{
+	// Generations are only reused after wrapping around, so handles released by ClearInstances() stay invalid without touching every entry.
+	LastInstanceHandleGeneration++;
+	const int32 Id = InstanceHandleEntries.Add(FSplineInstanceHandleEntry(Payload, LastInstanceHandleGeneration));
+	return FSplineInstanceHandle(Id, LastInstanceHandleGeneration);
+}
+
+void USplineInstantiatorCompBase::RemoveInstanceHandle(FSplineInstanceHandle Handle)
+{
+	if (IsInstanceHandleValid(Handle))
+	{
+		InstanceHandleEntries.RemoveAt(Handle.Id);
 	}
 }
 
-void USplineInstantiatorCompBase::ClearInstances()
+bool USplineInstantiatorCompBase::SetInstancePayload(FSplineInstanceHandle Handle, int32 Payload)
 {
-	for (int32 i = 0; i < Instances.Num(); i++)
+	if (!IsInstanceHandleValid(Handle))
 	{
-		// Each child class will implement its own version of the method.
-		DestroyInstance(Instances[i]);
+		return false;
 	}
-	Instances.Empty();
+
+	InstanceHandleEntries[Handle.Id].Payload = Payload;
+	return true;
+}
+
+FSplineInstanceHandle USplineInstantiatorCompBase::FindInstanceHandleByPayload(int32 Payload) const
+{
+	for (auto It = InstanceHandleEntries.CreateConstIterator(); It; ++It)
+	{
+		if (It->Payload == Payload)
+		{
+			return FSplineInstanceHandle(It.GetIndex(), It->Generation);
+		}
+	}
+	return FSplineInstanceHandle();
+}
+
+void USplineInstantiatorCompBase::UpdateReplicatedState()
+{
+	if (!ShouldReplicateState())
+	{
+		return;
+	}
+
+	// The raw curve keys are replicated, so clients rebuild exactly the curves the instances are generated from.
+	ReplicatedSplinePoints.SetCurves(SplineCurves);
+	bReplicatedClosedLoop = IsClosedLoop();
+	ReplicatedContentHash = ComputeContentHash(SplineCurves, bReplicatedClosedLoop);
+	AppliedContentHash = ReplicatedContentHash;
+}
+
+void USplineInstantiatorCompBase::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(USplineInstantiatorCompBase, InstantiationSettings);
+	DOREPLIFETIME(USplineInstantiatorCompBase, ReplicatedSplinePoints);
+	DOREPLIFETIME(USplineInstantiatorCompBase, bReplicatedClosedLoop);
+	DOREPLIFETIME(USplineInstantiatorCompBase, ReplicatedContentHash);
+}
+
+#if WITH_EDITOR
+void USplineInstantiatorCompBase::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	// Resets an UpAxis made incompatible by a ForwardAxis change. Done here, so it belongs to the same transaction as the edit and a single undo reverts both.
+	if (PropertyChangedEvent.GetMemberPropertyName() == GET_MEMBER_NAME_CHECKED(USplineInstantiatorCompBase, InstantiationSettings) &&
+		PropertyChangedEvent.GetPropertyName() == GET_MEMBER_NAME_CHECKED(FSplineInstantiationInfo, ForwardAxis) &&
+		!FOrientationAxisHelpers::IsUpAxisCompatible(InstantiationSettings.ForwardAxis, InstantiationSettings.UpAxis))
+	{
+		InstantiationSettings.UpAxis = EOrientationAxis::None;
+	}
+
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+}
+
+void USplineInstantiatorCompBase::PostEditUndo()
+{
+	Super::PostEditUndo();
+
+	// Instances are kept out of transactions, so they still match the live objects: 
+	// they only need to be rebuilt if the undo restored different InstantiationSettings.
+	if (HasInstances() && GetTypeHash(InstantiationSettings) != GeneratedSettingsHash)
+	{
+		Regenerate();
+	}
+}
+#endif
+
+void USplineInstantiatorCompBase::OnRep_SplineState()
+{
+	FSplineCurves ReceivedCurves;
+	ReplicatedSplinePoints.GetCurves(ReceivedCurves);
+
+	// The replicated properties may arrive in separate updates: regenerate only once the received state matches the server hash.
+	if (ReplicatedContentHash == AppliedContentHash || ComputeContentHash(ReceivedCurves, bReplicatedClosedLoop) != ReplicatedContentHash)
+	{
+		return;
+	}
+
+	SplineCurves.Position.Points = MoveTemp(ReceivedCurves.Position.Points);
+	SplineCurves.Rotation.Points = MoveTemp(ReceivedCurves.Rotation.Points);
+	SplineCurves.Scale.Points = MoveTemp(ReceivedCurves.Scale.Points);
+	SetClosedLoop(bReplicatedClosedLoop, false);
+	UpdateSpline();
+
+	Regenerate();
+
+	AppliedContentHash = ReplicatedContentHash;
+}
+
+bool USplineInstantiatorCompBase::ShouldReplicateState() const
+{
+	const UWorld* World = GetWorld();
+	return World && World->IsGameWorld() && GetIsReplicated() && GetOwnerRole() == ROLE_Authority;
+}
+
+TArray<double> USplineInstantiatorCompBase::GetSegmentStartDistances() const
+{
+	const int32 SegmentsCount = GetNumberOfSplineSegments();
+
+	TArray<double> SegmentStartDistances;
+	SegmentStartDistances.Reserve(SegmentsCount + 1);
+	SegmentStartDistances.Add(0.0);
+
+	// Segment lengths are short enough for float: only their sum needs double precision.
+	double AccumulatedDistance = 0.0;
+	for (int32 i = 0; i < SegmentsCount; i++)
+	{
+		AccumulatedDistance += GetSegmentLength(i);
+		SegmentStartDistances.Add(AccumulatedDistance);
+	}
+
+	return SegmentStartDistances;
+}
+
+void USplineInstantiatorCompBase::GetLocalPositionAndTangentAtDistance(double Distance, const TArray<double>& SegmentStartDistances, FVector& OutPosition, FVector& OutTangent) const
+{
+	const TArray<FInterpCurvePointVector>& Points = SplineCurves.Position.Points;
+	const int32 SegmentsCount = SegmentStartDistances.Num() - 1;
+
+	OutPosition = Points.Num() > 0 ? FVector(Points[0].OutVal) : FVector::ZeroVector;
+	OutTangent = FVector::ZeroVector;
+	if (SegmentsCount <= 0 || Points.Num() == 0)
+	{
+		return;
+	}
+
+	// The segment containing the distance is the last one starting before it.
+	const int32 SegmentIndex = FMath::Clamp(Algo::UpperBound(SegmentStartDistances, Distance) - 1, 0, SegmentsCount - 1);
+
+	// Both values are measured from the start of the segment, so they are small enough for float.
+	const double DistanceInSegment = Distance - SegmentStartDistances[SegmentIndex];
+	const double SegmentLength = SegmentStartDistances[SegmentIndex + 1] - SegmentStartDistances[SegmentIndex];
+	const double Alpha = GetSegmentParamFromLength(SegmentIndex, static_cast<float>(DistanceInSegment), static_cast<float>(SegmentLength));
+
+	// The last segment of a closed loop ends on the first point.
+	const bool bIsLoopSegment = SegmentIndex + 1 >= Points.Num();
+	const FInterpCurvePointVector& StartPoint = Points[SegmentIndex];
+	const FInterpCurvePointVector& EndPoint = Points[bIsLoopSegment ? 0 : SegmentIndex + 1];
+	const double KeyDiff = bIsLoopSegment ? SplineCurves.Position.LoopKeyOffset : EndPoint.InVal - StartPoint.InVal;
+
+	// Same evaluation as FInterpCurve::Eval and EvalDerivative, with a double parameter instead of a float input key.
+	if (KeyDiff <= 0.0 || StartPoint.InterpMode == CIM_Constant)
+	{
+		OutPosition = StartPoint.OutVal;
+	}
+	else if (StartPoint.InterpMode == CIM_Linear)
+	{
+		OutPosition = FMath::Lerp(FVector(StartPoint.OutVal), FVector(EndPoint.OutVal), Alpha);
+		OutTangent = (EndPoint.OutVal - StartPoint.OutVal) / KeyDiff;
+	}
+	else
+	{
+		const FVector StartTangent = StartPoint.LeaveTangent * KeyDiff;
+		const FVector EndTangent = EndPoint.ArriveTangent * KeyDiff;
+		OutPosition = FMath::CubicInterp(FVector(StartPoint.OutVal), StartTangent, FVector(EndPoint.OutVal), EndTangent, Alpha);
+		OutTangent = FMath::CubicInterpDerivative(FVector(StartPoint.OutVal), StartTangent, FVector(EndPoint.OutVal), EndTangent, Alpha) / KeyDiff;
+	}
+}
+
+uint32 USplineInstantiatorCompBase::ComputeContentHash(const FSplineCurves& Curves, bool bInClosedLoop) const
+{
+	const uint32 Hash = HashCombine(GetTypeHash(InstantiationSettings), GetTypeHash(bInClosedLoop));
+	return HashCombine(Hash, FSplinePointReplicationArray::HashCurves(Curves));
 }
 
 int32 USplineInstantiatorCompBase::GetSectionsCount() const
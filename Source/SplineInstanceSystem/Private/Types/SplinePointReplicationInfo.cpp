@@ -0,0 +1,103 @@
+#include "Types/SplinePointReplicationInfo.h"
+
+namespace
+{
+	// Exact comparisons: any change, however small, must reach the clients to keep the content hash consistent.
+	bool AreCurveKeysEqual(const FInterpCurvePointVector& A, const FInterpCurvePointVector& B)
+	{
+		return A.InVal == B.InVal
+			&& A.OutVal == B.OutVal
+			&& A.ArriveTangent == B.ArriveTangent
+			&& A.LeaveTangent == B.LeaveTangent
+			&& A.InterpMode == B.InterpMode;
+	}
+
+	bool AreCurveKeysEqual(const FSplineQuatCurveKey& A, const FSplineQuatCurveKey& B)
+	{
+		return A.InVal == B.InVal
+			&& A.OutVal == B.OutVal
+			&& A.ArriveTangent == B.ArriveTangent
+			&& A.LeaveTangent == B.LeaveTangent
+			&& A.InterpMode == B.InterpMode;
+	}
+
+	template<typename T>
+	uint32 HashCurveKeys(const TArray<FInterpCurvePoint<T>>& Points, uint32 Hash)
+	{
+		// Field by field, so struct padding never reaches the hash.
+		for (const FInterpCurvePoint<T>& Point : Points)
+		{
+			Hash = FCrc::MemCrc32(&Point.InVal, sizeof(Point.InVal), Hash);
+			Hash = FCrc::MemCrc32(&Point.OutVal, sizeof(Point.OutVal), Hash);
+			Hash = FCrc::MemCrc32(&Point.ArriveTangent, sizeof(Point.ArriveTangent), Hash);
+			Hash = FCrc::MemCrc32(&Point.LeaveTangent, sizeof(Point.LeaveTangent), Hash);
+			Hash = HashCombine(Hash, GetTypeHash(static_cast<uint8>(Point.InterpMode.GetValue())));
+		}
+		return Hash;
+	}
+}
+
+void FSplinePointReplicationArray::SetCurves(const FSplineCurves& Curves)
+{
+	const TArray<FInterpCurvePointVector>& PositionPoints = Curves.Position.Points;
+	const TArray<FInterpCurvePointQuat>& RotationPoints = Curves.Rotation.Points;
+	const TArray<FInterpCurvePointVector>& ScalePoints = Curves.Scale.Points;
+	const int32 PointsCount = PositionPoints.Num();
+
+	// Points are only ever removed from the tail, so each item keeps PointIndex equal to its array index.
+	if (Items.Num() > PointsCount)
+	{
+		Items.SetNum(PointsCount);
+		MarkArrayDirty();
+	}
+
+	for (int32 i = 0; i < PointsCount; i++)
+	{
+		// The spline component keeps its three curves in sync: the fallbacks only guard against malformed data.
+		const FSplineQuatCurveKey Rotation = RotationPoints.IsValidIndex(i)
+			? FSplineQuatCurveKey(RotationPoints[i])
+			: FSplineQuatCurveKey(FInterpCurvePointQuat(PositionPoints[i].InVal, FQuat::Identity));
+		const FInterpCurvePointVector Scale = ScalePoints.IsValidIndex(i)
+			? ScalePoints[i]
+			: FInterpCurvePointVector(PositionPoints[i].InVal, FVector(1.0f));
+
+		if (!Items.IsValidIndex(i))
+		{
+			MarkItemDirty(Items.Add_GetRef(FSplinePointReplicationItem(i, PositionPoints[i], Rotation, Scale)));
+		}
+		else if (!AreCurveKeysEqual(Items[i].Position, PositionPoints[i]) 
+			|| !AreCurveKeysEqual(Items[i].Rotation, Rotation) 
+			|| !AreCurveKeysEqual(Items[i].Scale, Scale))
+		{
+			Items[i] = FSplinePointReplicationItem(i, PositionPoints[i], Rotation, Scale);
+			MarkItemDirty(Items[i]);
+		}
+	}
+}
+
+void FSplinePointReplicationArray::GetCurves(FSplineCurves& OutCurves) const
+{
+	TArray<FSplinePointReplicationItem> SortedItems = Items;
+	SortedItems.Sort([](const FSplinePointReplicationItem& A, const FSplinePointReplicationItem& B)
+		{
+			return A.PointIndex < B.PointIndex;
+		});
+
+	OutCurves.Position.Points.Reset(SortedItems.Num());
+	OutCurves.Rotation.Points.Reset(SortedItems.Num());
+	OutCurves.Scale.Points.Reset(SortedItems.Num());
+
+	for (const FSplinePointReplicationItem& Item : SortedItems)
+	{
+		OutCurves.Position.Points.Add(Item.Position);
+		OutCurves.Rotation.Points.Add(Item.Rotation.ToCurvePoint());
+		OutCurves.Scale.Points.Add(Item.Scale);
+	}
+}
+
+uint32 FSplinePointReplicationArray::HashCurves(const FSplineCurves& Curves)
+{
+	uint32 Hash = HashCurveKeys(Curves.Position.Points, 0);
+	Hash = HashCurveKeys(Curves.Rotation.Points, Hash);
+	return HashCurveKeys(Curves.Scale.Points, Hash);
+}
@@ -4,6 +4,8 @@
 #include "Components/SplineComponent.h"
 #include "Types/SplineInstantiationInfo.h"
 #include "Types/SplineSegmentInfo.h"
+#include "Types/SplinePointReplicationInfo.h"
+#include "Types/SplineInstanceHandle.h"
 #include "SplineInstantiatorCompBase.generated.h"
 
 DEFINE_LOG_CATEGORY_STATIC(LogSplineInstantiator, Log, All);
@@ -18,14 +20,47 @@ class SPLINEINSTANCESYSTEM_API USplineInstantiatorCompBase : public USplineCompo
 
 public:	
 	/* Foundamental parameters for object placement along a spline. */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SplineInstantiationSystem")
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, ReplicatedUsing = OnRep_SplineState, Category = "SplineInstantiationSystem")
 	FSplineInstantiationInfo InstantiationSettings;
 
 protected:
-	/* The objects instantiated by this component. */
-	UPROPERTY(BlueprintReadOnly, Category = "SplineInstantiationSystem")
+	/* The objects instantiated by this component. 
+	Kept out of transactions like the instances themselves, so undo never rolls it back to objects that no longer exist (see PostEditUndo()). */
+	UPROPERTY(NonTransactional, BlueprintReadOnly, Category = "SplineInstantiationSystem")
 	TArray<UObject*> Instances;
 
+	/* The handle-based instances, indexed by handle Id (see UsesInstanceHandles()). 
+	Not tracked by the garbage collector, nor serialized or duplicated (see DestroyHandleInstances()). */
+	TSparseArray<FSplineInstanceHandleEntry> InstanceHandleEntries;
+
+	/* The spline curve keys replicated to clients, which rebuild the spline and regenerate instances locally. */
+	UPROPERTY(Transient, ReplicatedUsing = OnRep_SplineState)
+	FSplinePointReplicationArray ReplicatedSplinePoints;
+
+	/* Whether the replicated spline is a closed loop. */
+	UPROPERTY(Transient, ReplicatedUsing = OnRep_SplineState)
+	bool bReplicatedClosedLoop = false;
+
+	/* Hash of the replicated spline state, used by clients to know when the received state is complete. */
+	UPROPERTY(Transient, ReplicatedUsing = OnRep_SplineState)
+	uint32 ReplicatedContentHash = 0;
+
+private:
+	/* Whether instances have been generated and not cleared since. Serialized and duplicated, unlike the handle store, 
+	so a reloaded or duplicated handle-based component still knows it owns instances. */
+	UPROPERTY(NonTransactional)
+	bool bInstantiated = false;
+
+	/* Hash of the InstantiationSettings the current instances have been generated from. */
+	UPROPERTY(NonTransactional)
+	uint32 GeneratedSettingsHash = 0;
+
+	/* Hash of the spline state the current instances have been generated from. */
+	uint32 AppliedContentHash = 0;
+
+	/* Generation given to the last registered instance handle. Unsigned, so it wraps around on overflow. */
+	uint32 LastInstanceHandleGeneration = 0;
+
 public:
 	USplineInstantiatorCompBase();
 
@@ -41,6 +76,44 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "SplineInstantiationSystem")
 	void ClearInstances();
 
+	/**
+	 * @brief Returns true if the InstantiationSettings are valid. Logs an error for each invalid setting.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "SplineInstantiationSystem")
+	bool CanInstantiate() const;
+
+	/**
+	 * @brief Deletes all generated instances and generates them again from the current spline and InstantiationSettings.
+	 * 
+	 * Does nothing if the InstantiationSettings are not valid, so the current instances are kept.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "SplineInstantiationSystem")
+	void Regenerate();
+
+	/**
+	 * @brief Returns true if this component currently owns generated instances.
+	 * 
+	 * Also true for a reloaded or duplicated handle-based component, whose handles are not kept (see DestroyHandleInstances()).
+	 */
+	UFUNCTION(BlueprintPure, Category = "SplineInstantiationSystem")
+	FORCEINLINE bool HasInstances() const { return bInstantiated || Instances.Num() > 0 || InstanceHandleEntries.Num() > 0; }
+
+	/**
+	 * @brief Copies the current spline points and InstantiationSettings into the replicated state.
+	 *
+	 * Only the changed points are sent, and clients regenerate their own instances from them.
+	 * Instantiate() calls this automatically on the server; call it again after editing the spline at runtime.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "SplineInstantiationSystem")
+	void UpdateReplicatedState();
+
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+	virtual void PostEditUndo() override;
+#endif
+
 protected:
 	/**
 	 * @brief Returns the number of sections the spline will be divided into, based on the InstantiationMethod.
@@ -68,4 +141,120 @@ protected:
 	UFUNCTION(BlueprintCallable, BlueprintNativeEvent, Category = "SplineInstantiationSystem")
 	void DestroyInstance(UObject* Instance);
 	virtual void DestroyInstance_Implementation(UObject* Instance) { }
+
+	/**
+	 * @brief Returns true if this component generates handle-based instances instead of UObjects.
+	 * 
+	 * Child classes whose instances don't need to be UObjects (e.g. instanced static mesh indices or plain structs) 
+	 * override this to return true, together with GenerateInstancePayload() and DestroyHandleInstances().
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintNativeEvent, Category = "SplineInstantiationSystem")
+	bool UsesInstanceHandles() const;
+	virtual bool UsesInstanceHandles_Implementation() const { return false; }
+
+	/**
+	 * @brief Generates a handle-based instance along the spline. Only called if UsesInstanceHandles() returns true.
+	 * 
+	 * Child classes must override this function to specify their own behavior.
+	 * @param SplineSegment The spline segment along which the generated instance will be positioned.
+	 * @return The payload stored with the instance handle (e.g. an instanced static mesh index).
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintNativeEvent, Category = "SplineInstantiationSystem")
+	int32 GenerateInstancePayload(const FSplineSegmentInfo& SplineSegment);
+	virtual int32 GenerateInstancePayload_Implementation(const FSplineSegmentInfo& SplineSegment) { return INDEX_NONE; }
+
+	/**
+	 * @brief Destroys all the handle-based instances at once. Handles are released by ClearInstances() afterwards.
+	 * 
+	 * Called by ClearInstances() whenever UsesInstanceHandles() returns true, even if no handle is registered: 
+	 * the handle store is neither serialized nor duplicated, so a duplicated component (PIE, copy/paste) inherits 
+	 * the instances of its source without their handles. Child classes must destroy everything they own 
+	 * (e.g. clear their instanced static mesh) instead of iterating over the handles.
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintNativeEvent, Category = "SplineInstantiationSystem")
+	void DestroyHandleInstances();
+	virtual void DestroyHandleInstances_Implementation() { }
+
+	/**
+	 * @brief Registers a new handle-based instance.
+	 * @param Payload The payload to store with the handle.
+	 * @return The handle of the new instance.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "SplineInstantiationSystem")
+	FSplineInstanceHandle AddInstanceHandle(int32 Payload = INDEX_NONE);
+
+	/**
+	 * @brief Releases the given handle. The child class is responsible for destroying the instance it refers to.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "SplineInstantiationSystem")
+	void RemoveInstanceHandle(FSplineInstanceHandle Handle);
+
+	/**
+	 * @brief Replaces the payload stored with the given handle.
+	 * 
+	 * Child classes call this when their instances move, e.g. when removing an instanced static mesh instance changes the index of others.
+	 * @return False if the handle is not valid.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "SplineInstantiationSystem")
+	bool SetInstancePayload(FSplineInstanceHandle Handle, int32 Payload);
+
+	/**
+	 * @brief Returns the handle whose payload matches the given one, or an invalid handle if there is none. Linear in the number of instances.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "SplineInstantiationSystem")
+	FSplineInstanceHandle FindInstanceHandleByPayload(int32 Payload) const;
+
+	/**
+	 * @brief Returns true if the given handle refers to an existing instance.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "SplineInstantiationSystem")
+	FORCEINLINE bool IsInstanceHandleValid(FSplineInstanceHandle Handle) const
+	{
+		// A reused Id holds a newer generation: stale handles are rejected.
+		return InstanceHandleEntries.IsValidIndex(Handle.Id) && InstanceHandleEntries[Handle.Id].Generation == Handle.Generation;
+	}
+
+	/**
+	 * @brief Returns the payload stored with the given handle, or INDEX_NONE if the handle is not valid.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "SplineInstantiationSystem")
+	FORCEINLINE int32 GetInstancePayload(FSplineInstanceHandle Handle) const
+	{
+		return IsInstanceHandleValid(Handle) ? InstanceHandleEntries[Handle.Id].Payload : INDEX_NONE;
+	}
+
+private:
+	UFUNCTION()
+	void OnRep_SplineState();
+
+	/**
+	 * @brief Returns true if this component should push its spline state to clients.
+	 * 
+	 * Only true for replicated components with authority in a game world, so editor instantiation never fills the replicated state.
+	 */
+	bool ShouldReplicateState() const;
+
+	/**
+	 * @brief Returns the distance along the spline of each spline point, accumulated in double from the length of every segment.
+	 * 
+	 * The last entry is the total length of the spline.
+	 */
+	TArray<double> GetSegmentStartDistances() const;
+
+	/**
+	 * @brief Returns the local-space position and tangent at the given distance along the spline.
+	 * 
+	 * The segment is found in double precision, then its curve keys are evaluated directly with a double parameter, 
+	 * so precision doesn't degrade along multi-kilometre splines (a float input key would be quantized to the ulp of the segment index).
+	 * @param Distance The distance along the spline.
+	 * @param SegmentStartDistances The distances returned by GetSegmentStartDistances().
+	 * @param OutPosition The local-space position.
+	 * @param OutTangent The local-space tangent, the derivative of the position along the input key like GetTangentAtSplineInputKey().
+	 */
+	void GetLocalPositionAndTangentAtDistance(double Distance, const TArray<double>& SegmentStartDistances, FVector& OutPosition, FVector& OutTangent) const;
+
+	/**
+	 * @brief Returns the hash of the keys of the given spline curves, closed loop flag and the InstantiationSettings.
+	 */
+	uint32 ComputeContentHash(const FSplineCurves& Curves, bool bInClosedLoop) const;
 };
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SplineInstanceHandle.generated.h"
+
+/**
+ * @brief Lightweight identifier of an instance generated along a spline, for instances that are not UObjects.
+ *
+ * Ids are compact and reused once their instance has been removed: the Generation tells a reused Id apart from a stale handle.
+ * Whether a handle still refers to an instance can only be known by its component, see USplineInstantiatorCompBase::IsInstanceHandleValid().
+ */
+USTRUCT(BlueprintType)
+struct FSplineInstanceHandle
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly)
+	int32 Id = INDEX_NONE;
+
+	/* Wraps around on overflow. Not exposed to Blueprints, which don't support unsigned integers. */
+	UPROPERTY()
+	uint32 Generation = 0;
+
+	FSplineInstanceHandle() = default;
+
+	FSplineInstanceHandle(int32 InId, uint32 InGeneration)
+		: Id(InId), Generation(InGeneration) { }
+
+	/**
+	 * @brief Returns true if the handle has been assigned an Id. A set handle may still be stale.
+	 */
+	FORCEINLINE bool IsSet() const { return Id != INDEX_NONE; }
+
+	FORCEINLINE bool operator==(const FSplineInstanceHandle& Other) const { return Id == Other.Id && Generation == Other.Generation; }
+	FORCEINLINE bool operator!=(const FSplineInstanceHandle& Other) const { return !(*this == Other); }
+
+	friend FORCEINLINE uint32 GetTypeHash(const FSplineInstanceHandle& Handle)
+	{
+		return HashCombine(GetTypeHash(Handle.Id), GetTypeHash(Handle.Generation));
+	}
+};
+
+/**
+ * @brief Storage of a handle-based instance: its payload and the generation of the handle that refers to it.
+ */
+struct FSplineInstanceHandleEntry
+{
+	int32 Payload = INDEX_NONE;
+	uint32 Generation = 0;
+
+	FSplineInstanceHandleEntry() = default;
+
+	FSplineInstanceHandleEntry(int32 InPayload, uint32 InGeneration)
+		: Payload(InPayload), Generation(InGeneration) { }
+};
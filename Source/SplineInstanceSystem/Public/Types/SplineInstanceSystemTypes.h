@@ -51,6 +51,20 @@ public:
 		}
 	}
 
+	/**
+	 * @brief Returns true if the given UpAxis can be used together with the given ForwardAxis, i.e. it is not parallel to it.
+	 * 
+	 * Only None is compatible with a None ForwardAxis.
+	 */
+	FORCEINLINE static bool IsUpAxisCompatible(EOrientationAxis ForwardAxis, EOrientationAxis UpAxis)
+	{
+		if (ForwardAxis == EOrientationAxis::None)
+		{
+			return UpAxis == EOrientationAxis::None;
+		}
+		return UpAxis != ForwardAxis && UpAxis != GetOppositeAxis(ForwardAxis);
+	}
+
 	/**
 	 * @brief Returns the display names of the given EOrientationAxis list.
 	 */
@@ -86,3 +100,17 @@ enum class ESplineInstantiationMethod : uint8
 	/* Generates enough instances to fill the entire length of the spline, respecting the specified SectionLength (see SplineInstantiationInfo.h). */
 	FillSpline = 3 UMETA(DisplayName = "Fill Spline")
 };
+
+/**
+ * @brief The space in which spline sections are sampled and handed to the instances.
+ */
+UENUM(BlueprintType)
+enum class ESplineSamplingMode : uint8
+{
+	/* Section positions are expressed in the component local-space. */
+	Local = 0 UMETA(DisplayName = "Local"),
+
+	/* The spline is split into chunks of ChunkLength, and section positions are expressed relative to the origin of their chunk.
+	Keeps the values handed to the instances small on multi-kilometre splines (see SplineSegmentInfo.h). */
+	ChunkRelative = 1 UMETA(DisplayName = "Chunk Relative")
+};
@@ -42,11 +42,35 @@ struct FSplineInstantiationInfo
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	TEnumAsByte<EComponentMobility::Type> Mobility = EComponentMobility::Static;
 
+	/* The space in which section positions are given to the instantiated objects. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	ESplineSamplingMode SamplingMode = ESplineSamplingMode::Local;
+
+	/* The length of each chunk whitch the spline will be split in. 
+	Only used if SamplingMode is set to ChunkRelative. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (EditCondition = "SamplingMode == ESplineSamplingMode::ChunkRelative", EditConditionHides, ClampMin = "1.0"))
+	float ChunkLength = 100000.0f;
+
 	FSplineInstantiationInfo() = default;
 
 	FSplineInstantiationInfo(EOrientationAxis InForwardAxis, EOrientationAxis InUpAxis, ESplineInstantiationMethod InInstantiationMethod, int32 InInstanceCount = 0,
-		float InSectionLenght = 100.0F, float InSpacing = 0.0F, EComponentMobility::Type InMobility = EComponentMobility::Type::Static)
+		float InSectionLenght = 100.0F, float InSpacing = 0.0F, EComponentMobility::Type InMobility = EComponentMobility::Type::Static,
+		ESplineSamplingMode InSamplingMode = ESplineSamplingMode::Local, float InChunkLength = 100000.0F)
 		: ForwardAxis(InForwardAxis), UpAxis(InUpAxis), InstantiationMethod(InInstantiationMethod), InstanceCount(InInstanceCount),
-		SectionLength(InSectionLenght), Spacing(InSpacing), Mobility(InMobility) { }
+		SectionLength(InSectionLenght), Spacing(InSpacing), Mobility(InMobility), SamplingMode(InSamplingMode), ChunkLength(InChunkLength) { }
+
+	friend FORCEINLINE uint32 GetTypeHash(const FSplineInstantiationInfo& Info)
+	{
+		uint32 Hash = GetTypeHash(static_cast<uint8>(Info.ForwardAxis));
+		Hash = HashCombine(Hash, GetTypeHash(static_cast<uint8>(Info.UpAxis)));
+		Hash = HashCombine(Hash, GetTypeHash(static_cast<uint8>(Info.InstantiationMethod)));
+		Hash = HashCombine(Hash, GetTypeHash(Info.InstanceCount));
+		Hash = HashCombine(Hash, GetTypeHash(Info.SectionLength));
+		Hash = HashCombine(Hash, GetTypeHash(Info.Spacing));
+		Hash = HashCombine(Hash, GetTypeHash(static_cast<uint8>(Info.Mobility)));
+		Hash = HashCombine(Hash, GetTypeHash(static_cast<uint8>(Info.SamplingMode)));
+		Hash = HashCombine(Hash, GetTypeHash(Info.ChunkLength));
+		return Hash;
+	}
 };
 
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/SplineComponent.h"
+#include "Net/Serialization/FastArraySerializer.h"
+#include "SplinePointReplicationInfo.generated.h"
+
+/**
+ * @brief A key of the spline rotation curve, replicated losslessly.
+ *
+ * FQuat is net-serialized as a normalized rotation, which would alter the values and the (non unit) tangents: components are replicated as-is instead.
+ */
+USTRUCT()
+struct FSplineQuatCurveKey
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	float InVal = 0.0f;
+
+	UPROPERTY()
+	FVector4 OutVal = FVector4(0.0f, 0.0f, 0.0f, 1.0f);
+
+	UPROPERTY()
+	FVector4 ArriveTangent = FVector4(0.0f, 0.0f, 0.0f, 0.0f);
+
+	UPROPERTY()
+	FVector4 LeaveTangent = FVector4(0.0f, 0.0f, 0.0f, 0.0f);
+
+	UPROPERTY()
+	TEnumAsByte<EInterpCurveMode> InterpMode = CIM_CurveAuto;
+
+	FSplineQuatCurveKey() = default;
+
+	explicit FSplineQuatCurveKey(const FInterpCurvePointQuat& Point)
+		: InVal(Point.InVal),
+		OutVal(Point.OutVal.X, Point.OutVal.Y, Point.OutVal.Z, Point.OutVal.W),
+		ArriveTangent(Point.ArriveTangent.X, Point.ArriveTangent.Y, Point.ArriveTangent.Z, Point.ArriveTangent.W),
+		LeaveTangent(Point.LeaveTangent.X, Point.LeaveTangent.Y, Point.LeaveTangent.Z, Point.LeaveTangent.W),
+		InterpMode(Point.InterpMode) { }
+
+	FInterpCurvePointQuat ToCurvePoint() const
+	{
+		return FInterpCurvePointQuat(InVal,
+			FQuat(OutVal.X, OutVal.Y, OutVal.Z, OutVal.W),
+			FQuat(ArriveTangent.X, ArriveTangent.Y, ArriveTangent.Z, ArriveTangent.W),
+			FQuat(LeaveTangent.X, LeaveTangent.Y, LeaveTangent.Z, LeaveTangent.W),
+			InterpMode);
+	}
+};
+
+/**
+ * @brief The keys of the spline curves at a given point, replicated as an item of FSplinePointReplicationArray.
+ */
+USTRUCT()
+struct FSplinePointReplicationItem : public FFastArraySerializerItem
+{
+	GENERATED_BODY()
+
+	/* Index of the point along the spline. Replicated item order is not guaranteed, so clients sort by it. */
+	UPROPERTY()
+	int32 PointIndex = INDEX_NONE;
+
+	/* The key of the position curve, in local-space. */
+	UPROPERTY()
+	FInterpCurvePointVector Position;
+
+	/* The key of the rotation curve. */
+	UPROPERTY()
+	FSplineQuatCurveKey Rotation;
+
+	/* The key of the scale curve. */
+	UPROPERTY()
+	FInterpCurvePointVector Scale;
+
+	FSplinePointReplicationItem() = default;
+
+	FSplinePointReplicationItem(int32 InPointIndex, const FInterpCurvePointVector& InPosition, const FSplineQuatCurveKey& InRotation, const FInterpCurvePointVector& InScale)
+		: PointIndex(InPointIndex), Position(InPosition), Rotation(InRotation), Scale(InScale) { }
+};
+
+/**
+ * @brief Delta-replicated keys of the spline curves.
+ *
+ * The raw curve keys are replicated without loss, so clients rebuild exactly the server spline and regenerate instances locally.
+ * Only the points that actually changed are sent.
+ */
+USTRUCT()
+struct SPLINEINSTANCESYSTEM_API FSplinePointReplicationArray : public FFastArraySerializer
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<FSplinePointReplicationItem> Items;
+
+	/**
+	 * @brief Updates the replicated items to match the keys of the given curves, marking dirty only the ones that changed.
+	 *
+	 * Must only be called on the server.
+	 * @param Curves The spline curves.
+	 */
+	void SetCurves(const FSplineCurves& Curves);
+
+	/**
+	 * @brief Writes the replicated keys, ordered by point index, into the given curves.
+	 *
+	 * Only the keys are written: the caller must update the spline to rebuild the reparametrization table.
+	 */
+	void GetCurves(FSplineCurves& OutCurves) const;
+
+	/**
+	 * @brief Returns a hash of the keys of the given curves.
+	 */
+	static uint32 HashCurves(const FSplineCurves& Curves);
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParams)
+	{
+		return FFastArraySerializer::FastArrayDeltaSerialize<FSplinePointReplicationItem, FSplinePointReplicationArray>(Items, DeltaParams, *this);
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits<FSplinePointReplicationArray> : public TStructOpsTypeTraitsBase2<FSplinePointReplicationArray>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true
+	};
+};
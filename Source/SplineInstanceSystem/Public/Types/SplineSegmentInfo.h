@@ -7,6 +7,7 @@
  * @brief Represents a spline segment, including an incoming and outgoing tangent. 
  * 
  * Useful for instantiating objects along splines.
+ * Positions are relative to ChunkOrigin, which is the zero vector unless the spline is sampled in chunks.
  */
 USTRUCT(BlueprintType)
 struct FSplineSegmentInfo
@@ -25,9 +26,24 @@ struct FSplineSegmentInfo
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	FVector EndTangent = FVector::ZeroVector;
 
+	/* The local-space origin of the chunk the segment belongs to. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FVector ChunkOrigin = FVector::ZeroVector;
+
 	FSplineSegmentInfo() = default;
 
-	FSplineSegmentInfo(const FVector& InStartPosition, const FVector& InStartTangent, const FVector& InEndPosition, const FVector& InEndTangent)
-	: StartPosition(InStartPosition), StartTangent(InStartTangent), EndPosition(InEndPosition), EndTangent(InEndTangent) { }
+	FSplineSegmentInfo(const FVector& InStartPosition, const FVector& InStartTangent, const FVector& InEndPosition, const FVector& InEndTangent,
+		const FVector& InChunkOrigin = FVector::ZeroVector)
+	: StartPosition(InStartPosition), StartTangent(InStartTangent), EndPosition(InEndPosition), EndTangent(InEndTangent), ChunkOrigin(InChunkOrigin) { }
+
+	/**
+	 * @brief Returns the starting position in local-space.
+	 */
+	FORCEINLINE FVector GetLocalStartPosition() const { return ChunkOrigin + StartPosition; }
+
+	/**
+	 * @brief Returns the ending position in local-space.
+	 */
+	FORCEINLINE FVector GetLocalEndPosition() const { return ChunkOrigin + EndPosition; }
 };
 
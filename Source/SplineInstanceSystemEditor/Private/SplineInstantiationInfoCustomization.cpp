@@ -1,12 +1,14 @@
 ﻿#include "SplineInstantiationInfoCustomization.h"
 #include "IDetailChildrenBuilder.h"
-#include "IPropertyUtilities.h"
+#include "IDetailPropertyRow.h"
 
-#include "Async/Async.h"
+#include "Editor.h"
+#include "TimerManager.h"
 
 // Runtime module
 #include "Types/SplineInstantiationInfo.h"
 #include "Types/SplineInstanceSystemTypes.h"
+#include "Components/SplineInstantiatorCompBase.h"
 
 // Slate 
 #include "DetailWidgetRow.h"
@@ -17,6 +19,28 @@
 
 #define LOCTEXT_NAMESPACE "SplineInstanceSystem"
 
+namespace
+{
+	/* Components waiting to be regenerated. Shared by all customizations, so an edit on a multi-selection is applied in a single pass. */
+	TSet<TWeakObjectPtr<USplineInstantiatorCompBase>> PendingRegenerations;
+
+	void FlushPendingRegenerations()
+	{
+		TSet<TWeakObjectPtr<USplineInstantiatorCompBase>> Components = MoveTemp(PendingRegenerations);
+		PendingRegenerations.Reset();
+
+		// Instances are derived from the settings and kept out of transactions: undoing the edit regenerates them (see PostEditUndo()).
+		for (const TWeakObjectPtr<USplineInstantiatorCompBase>& Component : Components)
+		{
+			if (Component.IsValid())
+			{
+				Component->Regenerate();
+				Component->MarkPackageDirty();
+			}
+		}
+	}
+}
+
 TSharedRef<IPropertyTypeCustomization> FSplineInstantiationInfoCustomization::MakeInstance()
 {
 	return MakeShareable<FSplineInstantiationInfoCustomization>(new FSplineInstantiationInfoCustomization);
@@ -38,6 +62,15 @@ void FSplineInstantiationInfoCustomization::CustomizeChildren(TSharedRef<IProper
 	TSharedPtr<IPropertyHandle> UpAxisHandle = nullptr;
 	TSharedPtr<IPropertyHandle> InstantiationMethodHandle = nullptr;
 
+	// Regenerate the edited components once per change, whatever the number of selected objects.
+	TWeakPtr<IPropertyHandle> WeakPropertyHandle = PropertyHandle;
+	FSimpleDelegate OnSettingsChanged = FSimpleDelegate::CreateLambda([WeakPropertyHandle]()
+		{
+			QueueRegeneration(WeakPropertyHandle.Pin());
+		});
+	PropertyHandle->SetOnPropertyValueChanged(OnSettingsChanged);
+	PropertyHandle->SetOnChildPropertyValueChanged(OnSettingsChanged);
+
 	// Loops on all property children to catch Forward and Up axis properties.
 	for (uint32 i = 0; i < NumChildren;	i++)
 	{
@@ -58,38 +91,35 @@ void FSplineInstantiationInfoCustomization::CustomizeChildren(TSharedRef<IProper
 			else if (ChildName == GET_MEMBER_NAME_CHECKED(FSplineInstantiationInfo, UpAxis))
 			{
 				UpAxisHandle = ChildHandle;
-				TArray<EOrientationAxis> UpAxisValidValues = FilterUpAxisOptions(ForwardAxisHandle, UpAxisHandle);
-				ValidateUpAxisValue(UpAxisHandle, UpAxisValidValues);
-				CreateUpAxisCustomView(ChildBuilder, ForwardAxisHandle, UpAxisHandle, UpAxisValidValues); // Customize UpAxis property.
+				CreateUpAxisCustomView(ChildBuilder, ForwardAxisHandle, UpAxisHandle, FilterUpAxisOptions(ForwardAxisHandle, UpAxisHandle)); // Customize UpAxis property.
 			}
 			// Catch InstantiationMethod - needed for InstanceCount customization.
 			else if (ChildName == GET_MEMBER_NAME_CHECKED(FSplineInstantiationInfo, InstantiationMethod))
 			{
 				InstantiationMethodHandle = ChildHandle;
-
-				// Set callback to update InstanceCount when InstantiationMethod changes.
-				InstantiationMethodHandle->SetOnPropertyValueChanged(FSimpleDelegate::CreateLambda([&CustomizationUtils]()
-					{
-						CustomizationUtils.GetPropertyUtilities()->ForceRefresh();
-					}));
-
-				// Then add InstantiationMethod property normally.
 				ChildBuilder.AddProperty(ChildHandle);
 			}
 			// Catch InstanceCount
 			else if (ChildName == GET_MEMBER_NAME_CHECKED(FSplineInstantiationInfo, InstanceCount))
 			{
-				// Get InstantiationMethod current value.
-				uint8 InstantiationMethodValue;
-				InstantiationMethodHandle->GetValue(InstantiationMethodValue);
-				ESplineInstantiationMethod InstantiationMethod = static_cast<ESplineInstantiationMethod>(InstantiationMethodValue);
+				// Make InstanceCount property only appear if InstantiationMethod is set to an InstanceCount-method.
+				// The row evaluates its own visibility, so InstantiationMethod changes don't need a full panel refresh.
+				ChildBuilder.AddProperty(ChildHandle)
+					.Visibility(TAttribute<EVisibility>::Create(TAttribute<EVisibility>::FGetter::CreateLambda([InstantiationMethodHandle]()
+						{
+							// Get InstantiationMethod current value. Keep the row visible if the selected objects have different values.
+							uint8 InstantiationMethodValue;
+							if (!InstantiationMethodHandle.IsValid() || InstantiationMethodHandle->GetValue(InstantiationMethodValue) != FPropertyAccess::Success)
+							{
+								return EVisibility::Visible;
+							}
+							ESplineInstantiationMethod InstantiationMethod = static_cast<ESplineInstantiationMethod>(InstantiationMethodValue);
 
-				if (InstantiationMethod == ESplineInstantiationMethod::InstanceCount_SplineClamp ||
-					InstantiationMethod == ESplineInstantiationMethod::InstanceCount_AdjustSpline)
-				{
-					// Make InstanceCount property only appear if InstantiationMethod is set to an InstanceCount-method.
-					ChildBuilder.AddProperty(ChildHandle);
-				}
+							return InstantiationMethod == ESplineInstantiationMethod::InstanceCount_SplineClamp ||
+								InstantiationMethod == ESplineInstantiationMethod::InstanceCount_AdjustSpline
+								? EVisibility::Visible
+								: EVisibility::Collapsed;
+						})));
 			}
 			// Add other properties normally.
 			else
@@ -100,87 +130,80 @@ void FSplineInstantiationInfoCustomization::CustomizeChildren(TSharedRef<IProper
 	}
 }
 
-TArray<EOrientationAxis> FSplineInstantiationInfoCustomization::FilterUpAxisOptions(TSharedPtr<IPropertyHandle> ForwardAxisHandle, TSharedPtr<IPropertyHandle> UpAxisHandle)
+const FSplineInstantiationInfoCustomization::FUpAxisOptions& FSplineInstantiationInfoCustomization::FilterUpAxisOptions(TSharedPtr<IPropertyHandle> ForwardAxisHandle, TSharedPtr<IPropertyHandle> UpAxisHandle)
 {
-	if (ForwardAxisHandle.IsValid() && UpAxisHandle.IsValid())
+	static const FUpAxisOptions NoOptions;
+
+	if (!ForwardAxisHandle.IsValid() || !UpAxisHandle.IsValid())
+	{
+		return NoOptions;
+	}
+
+	// Get ForwardAxis current value. Selected objects may have different values.
+	uint8 ForwardAxisValue;
+	if (ForwardAxisHandle->GetValue(ForwardAxisValue) != FPropertyAccess::Success)
+	{
+		return GetUpAxisOptions(EOrientationAxis::None, true);
+	}
+
+	return GetUpAxisOptions(static_cast<EOrientationAxis>(ForwardAxisValue));
+}
+
+const FSplineInstantiationInfoCustomization::FUpAxisOptions& FSplineInstantiationInfoCustomization::GetUpAxisOptions(EOrientationAxis ForwardAxis, bool bAllAxes)
+{
+	// Options for each ForwardAxis value, built once. Never modified afterwards, so returned references stay valid.
+	static TMap<EOrientationAxis, FUpAxisOptions> CachedOptions;
+	static FUpAxisOptions AllOptions;
+	static const FUpAxisOptions NoOptions;
+
+	if (AllOptions.Values.Num() == 0)
 	{
-		// Get ForwardAxis current value.
-		uint8 ForwardAxisValue;
-		ForwardAxisHandle->GetValue(ForwardAxisValue);
-		EOrientationAxis ForwardAxis = static_cast<EOrientationAxis>(ForwardAxisValue);
-		
 		if (UEnum* Enum = StaticEnum<EOrientationAxis>())
 		{
-			TArray<EOrientationAxis> FilteredOptions;
-
 			// Loops on all enum options.
 			for (int32 i = 0; i < Enum->NumEnums() - 1; i++)
 			{
-				EOrientationAxis Candidate = static_cast<EOrientationAxis>(Enum->GetValueByIndex(i));
+				AllOptions.Values.Add(static_cast<EOrientationAxis>(Enum->GetValueByIndex(i)));
+			}
+			AllOptions.DisplayNames = FOrientationAxisHelpers::GetDisplayNames(AllOptions.Values);
+
+			for (EOrientationAxis CachedForwardAxis : AllOptions.Values)
+			{
+				FUpAxisOptions& FilteredOptions = CachedOptions.Add(CachedForwardAxis);
 
-				// For each option check if it is candidable as UpVector.
-				bool bAllow = false;
-				if (ForwardAxis == EOrientationAxis::None)
+				for (EOrientationAxis Candidate : AllOptions.Values)
 				{
-					bAllow = (Candidate == EOrientationAxis::None);
-				}
-				else if (Candidate != ForwardAxis && Candidate != FOrientationAxisHelpers::GetOppositeAxis(ForwardAxis))
-				{
-					bAllow = true;
+					// If the option is candidable as UpVector, add it to the filtered options array.
+					if (FOrientationAxisHelpers::IsUpAxisCompatible(CachedForwardAxis, Candidate))
+					{
+						FilteredOptions.Values.Add(Candidate);
+					}
 				}
 
-				// If the option is a valid candidate, add it to the filtered options array.
-				if (bAllow)
-				{
-					FilteredOptions.Add(Candidate);
-				}
+				FilteredOptions.DisplayNames = FOrientationAxisHelpers::GetDisplayNames(FilteredOptions.Values);
 			}
-
-			return FilteredOptions;
 		}
 	}
 
-	return TArray<EOrientationAxis>();
-}
-
-void FSplineInstantiationInfoCustomization::ValidateUpAxisValue(TSharedPtr<IPropertyHandle> UpAxisHandle, const TArray<EOrientationAxis>& UpAxisValidValues)
-{
-	if (UpAxisHandle.IsValid())
+	if (bAllAxes)
 	{
-		// Get UpdAxis current value.
-		uint8 CurrentUpAxisValue;
-		UpAxisHandle->GetValue(CurrentUpAxisValue);
-		EOrientationAxis CurrentUpAxis = static_cast<EOrientationAxis>(CurrentUpAxisValue);
-
-		// If the current UpAxis value is incompatible with the ForwardAxis one, resets it.
-		if (!UpAxisValidValues.Contains(CurrentUpAxis))
-		{
-			ResetUpAxisValue(UpAxisHandle);
-		}
+		return AllOptions;
 	}
-}
 
-void FSplineInstantiationInfoCustomization::ResetUpAxisValue(TSharedPtr<IPropertyHandle> UpAxisHandle)
-{
-	if (UpAxisHandle.IsValid())
-	{
-		AsyncTask(ENamedThreads::GameThread, [UpAxisHandle]()
-			{
-				UpAxisHandle->SetValue(static_cast<uint8>(EOrientationAxis::None));
-			});
-	}
+	const FUpAxisOptions* FilteredOptions = CachedOptions.Find(ForwardAxis);
+	return FilteredOptions ? *FilteredOptions : NoOptions;
 }
 
 void FSplineInstantiationInfoCustomization::CreateUpAxisCustomView(IDetailChildrenBuilder& ChildBuilder, 
 	TSharedPtr<IPropertyHandle> ForwardAxisHandle, TSharedPtr<IPropertyHandle> UpAxisHandle, 
-	const TArray<EOrientationAxis>& UpAxisValidValues)
+	const FUpAxisOptions& UpAxisOptions)
 {
 	if (UEnum* Enum = StaticEnum<EOrientationAxis>())
 	{
 		TSharedPtr<SComboBox<TSharedPtr<FString>>> ComboBox;
 		
 		// Update ComboBox Options.
-		UpAxisComboBoxOptions = FOrientationAxisHelpers::GetDisplayNames(UpAxisValidValues);
+		UpAxisComboBoxOptions = UpAxisOptions.DisplayNames;
 
 		ChildBuilder.AddCustomRow(LOCTEXT("UpAxis", "Up Axis"))
 			.NameContent()
@@ -206,34 +229,64 @@ void FSplineInstantiationInfoCustomization::CreateUpAxisCustomView(IDetailChildr
 								UpAxisHandle->SetValue(NewValue);
 							}
 						})
-					.InitiallySelectedItem(UpAxisComboBoxOptions.Num() >= 0 ? UpAxisComboBoxOptions[0] : nullptr)
+					.InitiallySelectedItem(UpAxisComboBoxOptions.Num() > 0 ? UpAxisComboBoxOptions[0] : nullptr)
 					[
 						SNew(STextBlock)
 							.Text_Lambda([UpAxisHandle, Enum]()
 								{
 									uint8 Value;
-									UpAxisHandle->GetValue(Value);
+									if (UpAxisHandle->GetValue(Value) == FPropertyAccess::MultipleValues)
+									{
+										return LOCTEXT("MultipleValues", "Multiple Values");
+									}
 									return Enum->GetDisplayNameTextByValue(Value);
 								})
 					]
 			];
 
-		// Set callback to update UpAxis when ForwardAxis changes.
+		// Set callback to update UpAxis options when ForwardAxis changes.
+		// Only the UpAxis row is updated: the rest of the panel is left untouched.
+		// An incompatible UpAxis value has already been reset by the component, within the same transaction (see USplineInstantiatorCompBase::PostEditChangeProperty()).
 		ForwardAxisHandle->SetOnPropertyValueChanged(FSimpleDelegate::CreateLambda([=]()
 			{
-				TArray<EOrientationAxis> UpAxisValidValues = FilterUpAxisOptions(ForwardAxisHandle, UpAxisHandle);
-
-				// Revalidate UpAxis Options.
-				ValidateUpAxisValue(UpAxisHandle, UpAxisValidValues);
+				const FUpAxisOptions& NewUpAxisOptions = FilterUpAxisOptions(ForwardAxisHandle, UpAxisHandle);
 
 				if (ComboBox.IsValid())
 				{
 					// Update ComboBox Options and rebuild it.
-					UpAxisComboBoxOptions = FOrientationAxisHelpers::GetDisplayNames(UpAxisValidValues);
+					UpAxisComboBoxOptions = NewUpAxisOptions.DisplayNames;
 					ComboBox->RefreshOptions();
 				}
 			}));
 	}
 }
 
+void FSplineInstantiationInfoCustomization::QueueRegeneration(TSharedPtr<IPropertyHandle> StructPropertyHandle)
+{
+	if (!StructPropertyHandle.IsValid() || !GEditor)
+	{
+		return;
+	}
+
+	const bool bFlushScheduled = PendingRegenerations.Num() > 0;
+
+	TArray<UObject*> OuterObjects;
+	StructPropertyHandle->GetOuterObjects(OuterObjects);
+
+	for (UObject* OuterObject : OuterObjects)
+	{
+		// Templates and components that have never been instantiated are left alone.
+		USplineInstantiatorCompBase* Component = Cast<USplineInstantiatorCompBase>(OuterObject);
+		if (Component && !Component->IsTemplate() && Component->HasInstances())
+		{
+			PendingRegenerations.Add(Component);
+		}
+	}
+
+	if (!bFlushScheduled && PendingRegenerations.Num() > 0)
+	{
+		GEditor->GetTimerManager()->SetTimerForNextTick(&FlushPendingRegenerations);
+	}
+}
+
 #undef LOCTEXT_NAMESPACE
\ No newline at end of file
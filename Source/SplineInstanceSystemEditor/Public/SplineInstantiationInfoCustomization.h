@@ -19,29 +19,41 @@ public:
 	virtual void CustomizeChildren(TSharedRef<IPropertyHandle> PropertyHandle, IDetailChildrenBuilder& ChildBuilder, IPropertyTypeCustomizationUtils& CustomizationUtils) override;
 
 private:
+	/* UpAxis values compatible with a given ForwardAxis value, together with their display names. */
+	struct FUpAxisOptions
+	{
+		TArray<EOrientationAxis> Values;
+		TArray<TSharedPtr<FString>> DisplayNames;
+	};
+
 	TArray<TSharedPtr<FString>> UpAxisComboBoxOptions;
 
 	/**
-	 * @brief Returns a list of EOrientationAxis display names filtered by the ForwardAxis selected value.
+	 * @brief Returns the UpAxis options compatible with the ForwardAxis selected value.
+	 * 
+	 * Options are computed once for every ForwardAxis value and shared by all customizations.
+	 * If the selected objects have different ForwardAxis values, every axis is returned.
 	 * @param ForwardAxisHandle The handle for ForwardAxis property.
-	 * @param UpAxisHandle The handle for ForwardAxis property.
-	 */
-	TArray<EOrientationAxis> FilterUpAxisOptions(TSharedPtr<IPropertyHandle> ForwardAxisHandle, TSharedPtr<IPropertyHandle> UpAxisHandle);
-
-	/**
-	 * @brief Check if UpAxis property has a value compatible with the ForwardAxis one. If it is not, resets the UpAxis value.
 	 * @param UpAxisHandle The handle for UpAxis property.
-	 * @param UpAxisValidValues List of EOrientationAxis display names filtered by the ForwardAxis selected value.
 	 */
-	void ValidateUpAxisValue(TSharedPtr<IPropertyHandle> UpAxisHandle, const TArray<EOrientationAxis>& UpAxisValidValues);
+	static const FUpAxisOptions& FilterUpAxisOptions(TSharedPtr<IPropertyHandle> ForwardAxisHandle, TSharedPtr<IPropertyHandle> UpAxisHandle);
 
 	/**
-	 * @brief Set UpAxis property value to None.
-	 * @param UpAxisHandle The handle for UpAxis property.
+	 * @brief Returns the cached UpAxis options compatible with the given ForwardAxis value.
+	 * @param ForwardAxis The ForwardAxis value.
+	 * @param bAllAxes If true, returns every axis regardless of ForwardAxis.
 	 */
-	void ResetUpAxisValue(TSharedPtr<IPropertyHandle> UpAxisHandle);
+	static const FUpAxisOptions& GetUpAxisOptions(EOrientationAxis ForwardAxis, bool bAllAxes = false);
 
 	void CreateUpAxisCustomView(IDetailChildrenBuilder& ChildBuilder, 
 		TSharedPtr<IPropertyHandle> ForwardAxisHandle, TSharedPtr<IPropertyHandle> UpAxisHandle, 
-		const TArray<EOrientationAxis>& UpAxisValidValues);
+		const FUpAxisOptions& UpAxisOptions);
+
+	/**
+	 * @brief Queues the regeneration of the spline instantiator components edited through the given handle.
+	 * 
+	 * All the components queued during the same frame are regenerated once, on the next editor tick.
+	 * @param StructPropertyHandle The handle for the FSplineInstantiationInfo property.
+	 */
+	static void QueueRegeneration(TSharedPtr<IPropertyHandle> StructPropertyHandle);
 };
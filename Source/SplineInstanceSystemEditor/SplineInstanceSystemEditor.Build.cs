@@ -40,6 +40,7 @@ public class SplineInstanceSystemEditor : ModuleRules
 				"Slate",
 				"SlateCore",
 				"EditorStyle",
+				"UnrealEd",
 				"SplineInstanceSystem",
 				// ... add private dependencies that you statically link with here ...	
 			}